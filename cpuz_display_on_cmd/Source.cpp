@@ -1,9 +1,18 @@
+#pragma comment(lib, "setupapi.lib")
+
 #include <windows.h>
+#include <winioctl.h>
+#include <setupapi.h>
+#include <initguid.h>
+#include <emi.h>
 #include <intrin.h>
+#include <immintrin.h>
 #include <cstdio>
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include <thread>
+#include <vector>
 
 // ---------------------------------------------------------------------------
 // CPUID Wrappers
@@ -162,13 +171,10 @@ static void ShowFeatureFlags()
 
 // ---------------------------------------------------------------------------
 // Determine approximate logical vs physical cores
+// (CPUID reports cores per package; falls back to the logical count)
 // ---------------------------------------------------------------------------
-static void ShowCoreAndThreadCount()
+static int GetApproxPhysicalCores(int logicalCount)
 {
-    SYSTEM_INFO sysInfo;
-    GetSystemInfo(&sysInfo);
-    DWORD logicalCount = sysInfo.dwNumberOfProcessors;
-
     // Basic approach for physical cores using CPUID
     int cpuInfo[4] = { 0 };
     cpuid(cpuInfo, 0);
@@ -185,7 +191,7 @@ static void ShowCoreAndThreadCount()
     std::memcpy(&vendor[4], &cpuInfo[3], sizeof(int));  // EDX
     std::memcpy(&vendor[8], &cpuInfo[2], sizeof(int));  // ECX
 
-    int physicalCores = static_cast<int>(logicalCount);
+    int physicalCores = logicalCount;
 
     // If Intel and CPUID leaf 4 is available
     if (std::strstr(vendor, "Intel") && maxBasic >= 4) {
@@ -199,6 +205,15 @@ static void ShowCoreAndThreadCount()
         int coresPerPkg = (cpuInfo[2] & 0xFF) + 1;
         physicalCores = coresPerPkg;
     }
+    return physicalCores;
+}
+
+static void ShowCoreAndThreadCount()
+{
+    SYSTEM_INFO sysInfo;
+    GetSystemInfo(&sysInfo);
+    DWORD logicalCount = sysInfo.dwNumberOfProcessors;
+    int physicalCores = GetApproxPhysicalCores(static_cast<int>(logicalCount));
 
     printf("\nLogical Processors: %u\n", logicalCount);
     printf("Approx. Physical Cores: %d\n", physicalCores);
@@ -255,11 +270,670 @@ static void ShowCacheInfo()
     }
 }
 
+// ---------------------------------------------------------------------------
+// Energy metering via the Windows Energy Meter Interface (EMI).
+// On RAPL-capable Intel and AMD CPUs the EMI driver exposes the package,
+// core (PP0) and DRAM domains as channels, e.g. "RAPL_Package0_PKG".
+// ---------------------------------------------------------------------------
+struct EnergyChannel
+{
+    std::string name;
+};
+
+struct EnergyMeters
+{
+    std::vector<HANDLE> devices;
+    std::vector<unsigned> channelCounts;    // per device
+    std::vector<EnergyChannel> channels;
+    std::string unavailableReason;          // set when no channel was found
+};
+
+// Absolute energy (picowatt-hours) and the meter's own timestamp for that
+// reading (100 ns units), one entry per channel.
+struct EnergySample
+{
+    std::vector<std::uint64_t> energyPWh;
+    std::vector<std::uint64_t> time100ns;
+};
+
+static std::string WideToString(const WCHAR* str, size_t maxChars)
+{
+    std::wstring wide(str, wcsnlen(str, maxChars));
+    if (wide.empty()) {
+        return std::string();
+    }
+
+    int len = WideCharToMultiByte(CP_UTF8, 0, wide.c_str(), static_cast<int>(wide.size()),
+        nullptr, 0, nullptr, nullptr);
+    std::string out(len > 0 ? len : 0, '\0');
+    if (len > 0) {
+        WideCharToMultiByte(CP_UTF8, 0, wide.c_str(), static_cast<int>(wide.size()),
+            &out[0], len, nullptr, nullptr);
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Read EMI version/metadata from one device and register its channels.
+// ---------------------------------------------------------------------------
+static bool AddEnergyDevice(EnergyMeters& meters, HANDLE device)
+{
+    DWORD bytes = 0;
+    EMI_VERSION version = { 0 };
+    if (!DeviceIoControl(device, IOCTL_EMI_GET_VERSION, nullptr, 0,
+        &version, sizeof(version), &bytes, nullptr)) {
+        return false;
+    }
+
+    EMI_METADATA_SIZE metaSize = { 0 };
+    if (!DeviceIoControl(device, IOCTL_EMI_GET_METADATA_SIZE, nullptr, 0,
+        &metaSize, sizeof(metaSize), &bytes, nullptr) || metaSize.MetadataSize == 0) {
+        return false;
+    }
+
+    std::vector<BYTE> metadata(metaSize.MetadataSize);
+    if (!DeviceIoControl(device, IOCTL_EMI_GET_METADATA, nullptr, 0,
+        metadata.data(), metaSize.MetadataSize, &bytes, nullptr) || bytes > metadata.size()) {
+        return false;
+    }
+
+    // Every record, names included, must end inside the bytes actually returned.
+    std::vector<EnergyChannel> channels;
+
+    if (version.EmiVersion == EMI_VERSION_V1) {
+        size_t nameOffset = FIELD_OFFSET(EMI_METADATA_V1, MeteredHardwareName);
+        if (bytes < nameOffset) {
+            return false;
+        }
+        const EMI_METADATA_V1* md = reinterpret_cast<const EMI_METADATA_V1*>(metadata.data());
+        if (nameOffset + md->MeteredHardwareNameSize > bytes) {
+            return false;
+        }
+        EnergyChannel ch;
+        ch.name = WideToString(md->MeteredHardwareName, md->MeteredHardwareNameSize / sizeof(WCHAR));
+        channels.push_back(ch);
+    }
+    else if (version.EmiVersion == EMI_VERSION_V2) {
+        size_t offset = FIELD_OFFSET(EMI_METADATA_V2, Channels);
+        if (bytes < offset) {
+            return false;
+        }
+        const EMI_METADATA_V2* md = reinterpret_cast<const EMI_METADATA_V2*>(metadata.data());
+        if (md->ChannelCount == 0) {
+            return false;
+        }
+        for (USHORT i = 0; i < md->ChannelCount; ++i) {
+            if (offset + FIELD_OFFSET(EMI_CHANNEL_V2, ChannelName) > bytes) {
+                return false;
+            }
+            const EMI_CHANNEL_V2* chData =
+                reinterpret_cast<const EMI_CHANNEL_V2*>(metadata.data() + offset);
+            size_t length = EMI_CHANNEL_V2_LENGTH(chData->ChannelNameSize);
+            if (offset + length > bytes) {
+                return false;
+            }
+            EnergyChannel ch;
+            ch.name = WideToString(chData->ChannelName, chData->ChannelNameSize / sizeof(WCHAR));
+            channels.push_back(ch);
+            offset += length;
+        }
+    }
+    else {
+        return false;
+    }
+
+    meters.channels.insert(meters.channels.end(), channels.begin(), channels.end());
+    meters.devices.push_back(device);
+    meters.channelCounts.push_back(static_cast<unsigned>(channels.size()));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Enumerate every present energy meter device. Leaves meters.channels empty
+// (with a reason) on hosts or VMs that expose no meter.
+// ---------------------------------------------------------------------------
+static void OpenEnergyMeters(EnergyMeters& meters)
+{
+    HDEVINFO devInfo = SetupDiGetClassDevs(&GUID_DEVICE_ENERGY_METER, nullptr, nullptr,
+        DIGCF_PRESENT | DIGCF_DEVICEINTERFACE);
+    if (devInfo == INVALID_HANDLE_VALUE) {
+        meters.unavailableReason = "energy meter enumeration failed";
+        return;
+    }
+
+    bool accessDenied = false;
+    SP_DEVICE_INTERFACE_DATA ifData;
+    ifData.cbSize = sizeof(ifData);
+
+    for (DWORD i = 0; SetupDiEnumDeviceInterfaces(devInfo, nullptr, &GUID_DEVICE_ENERGY_METER, i, &ifData); ++i) {
+        DWORD detailSize = 0;
+        SetupDiGetDeviceInterfaceDetailA(devInfo, &ifData, nullptr, 0, &detailSize, nullptr);
+        if (detailSize == 0) {
+            continue;
+        }
+
+        std::vector<BYTE> detailBuf(detailSize);
+        SP_DEVICE_INTERFACE_DETAIL_DATA_A* detail =
+            reinterpret_cast<SP_DEVICE_INTERFACE_DETAIL_DATA_A*>(detailBuf.data());
+        detail->cbSize = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA_A);
+        if (!SetupDiGetDeviceInterfaceDetailA(devInfo, &ifData, detail, detailSize, nullptr, nullptr)) {
+            continue;
+        }
+
+        HANDLE device = CreateFileA(detail->DevicePath, GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (device == INVALID_HANDLE_VALUE) {
+            if (GetLastError() == ERROR_ACCESS_DENIED) {
+                accessDenied = true;
+            }
+            continue;
+        }
+
+        if (!AddEnergyDevice(meters, device)) {
+            CloseHandle(device);
+        }
+    }
+    SetupDiDestroyDeviceInfoList(devInfo);
+
+    if (meters.channels.empty()) {
+        meters.unavailableReason = accessDenied
+            ? "access denied (run as Administrator)"
+            : "no energy meter device";
+    }
+}
+
+static void CloseEnergyMeters(EnergyMeters& meters)
+{
+    for (HANDLE device : meters.devices) {
+        CloseHandle(device);
+    }
+    meters.devices.clear();
+    meters.channelCounts.clear();
+    meters.channels.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot all channels, in the order they were registered. Returns false if
+// any device could not be read or returned fewer channels than it reported.
+// ---------------------------------------------------------------------------
+static bool ReadEnergySample(const EnergyMeters& meters, EnergySample& sample)
+{
+    sample.energyPWh.clear();
+    sample.time100ns.clear();
+    for (size_t d = 0; d < meters.devices.size(); ++d) {
+        std::vector<EMI_CHANNEL_MEASUREMENT_DATA> data(meters.channelCounts[d]);
+        DWORD size = static_cast<DWORD>(data.size() * sizeof(EMI_CHANNEL_MEASUREMENT_DATA));
+        DWORD bytes = 0;
+        if (!DeviceIoControl(meters.devices[d], IOCTL_EMI_GET_MEASUREMENT, nullptr, 0,
+            data.data(), size, &bytes, nullptr) || bytes != size) {
+            return false;
+        }
+        for (const EMI_CHANNEL_MEASUREMENT_DATA& ch : data) {
+            sample.energyPWh.push_back(ch.AbsoluteEnergy);
+            sample.time100ns.push_back(ch.AbsoluteTime);
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Energy in joules consumed on one channel between two samples.
+// The counters are 64-bit accumulators; unsigned subtraction keeps the delta
+// correct across a single wraparound.
+// ---------------------------------------------------------------------------
+static double EnergyDeltaJoules(const EnergySample& before, const EnergySample& after, size_t channel)
+{
+    std::uint64_t deltaPWh = after.energyPWh[channel] - before.energyPWh[channel];
+    return static_cast<double>(deltaPWh) * 3.6e-9;  // 1 pWh = 3.6e-9 J
+}
+
+// ---------------------------------------------------------------------------
+// Time covered by one channel's two readings, from the meter's timestamps so
+// cached or periodically updated meters still give correct watts. Falls back
+// to the caller's wall-clock time when the meter provides no timestamp.
+// ---------------------------------------------------------------------------
+static double EnergyDeltaSeconds(const EnergySample& before, const EnergySample& after,
+    size_t channel, double fallbackSec)
+{
+    std::uint64_t t0 = before.time100ns[channel];
+    std::uint64_t t1 = after.time100ns[channel];
+    if (t1 <= t0) {
+        return fallbackSec;
+    }
+    return static_cast<double>(t1 - t0) * 1.0e-7;
+}
+
+static bool IsPackageChannel(const EnergyChannel& channel)
+{
+    return channel.name.find("PKG") != std::string::npos;
+}
+
+static bool HasPackageChannel(const EnergyMeters& meters)
+{
+    for (const EnergyChannel& ch : meters.channels) {
+        if (IsPackageChannel(ch)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Package energy for work/joule: the sum of all package domains (one per
+// socket). Callers must check HasPackageChannel() first.
+// ---------------------------------------------------------------------------
+static double PackageEnergyJoules(const EnergyMeters& meters,
+    const EnergySample& before, const EnergySample& after)
+{
+    double joules = 0.0;
+    for (size_t i = 0; i < meters.channels.size(); ++i) {
+        if (IsPackageChannel(meters.channels[i])) {
+            joules += EnergyDeltaJoules(before, after, i);
+        }
+    }
+    return joules;
+}
+
+// ---------------------------------------------------------------------------
+// Print per-channel joules and average watts, plus work/joule when given.
+// Returns work/joule, or a negative value when it is unavailable.
+// ---------------------------------------------------------------------------
+static double PrintEnergyReport(const EnergyMeters& meters, bool sampled,
+    const EnergySample& before, const EnergySample& after,
+    double elapsedSec, double work, const char* workUnit)
+{
+    if (meters.channels.empty()) {
+        printf("    Energy: unavailable (%s)\n", meters.unavailableReason.c_str());
+        return -1.0;
+    }
+    if (!sampled) {
+        printf("    Energy: unavailable (energy meter read failed)\n");
+        return -1.0;
+    }
+
+    for (size_t i = 0; i < meters.channels.size(); ++i) {
+        double joules = EnergyDeltaJoules(before, after, i);
+        double seconds = EnergyDeltaSeconds(before, after, i, elapsedSec);
+        printf("    %-24s: %10.3f J, %8.2f W avg\n",
+            meters.channels[i].name.c_str(), joules, joules / seconds);
+    }
+
+    if (workUnit == nullptr) {
+        return -1.0;
+    }
+    if (!HasPackageChannel(meters)) {
+        printf("    Work/Joule: unavailable (no package domain)\n");
+        return -1.0;
+    }
+    double joules = PackageEnergyJoules(meters, before, after);
+    if (joules <= 0.0) {
+        printf("    Work/Joule: unavailable (no package energy delta)\n");
+        return -1.0;
+    }
+    printf("    Work/Joule: %.3f %s/J (package)\n", work / joules, workUnit);
+    return work / joules;
+}
+
+// ---------------------------------------------------------------------------
+// Built-in compute kernels: 8 independent multiply-add chains per batch at
+// scalar, SSE2 (2 x double) and AVX (4 x double) width.
+// ---------------------------------------------------------------------------
+enum KernelWidth { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX };
+
+static const std::uint64_t kKernelBatchIters = 1u << 18;
+static const double kKernelMul = 0.999999;
+static const double kKernelAdd = 1.0e-7;
+
+static const char* KernelWidthName(KernelWidth width)
+{
+    switch (width) {
+    case KERNEL_SSE2: return "SSE2";
+    case KERNEL_AVX:  return "AVX";
+    default:          return "Scalar";
+    }
+}
+
+// Floating-point ops per batch: 8 chains x lanes x (mul + add)
+static double KernelBatchFlops(KernelWidth width)
+{
+    int lanes = (width == KERNEL_AVX) ? 4 : (width == KERNEL_SSE2) ? 2 : 1;
+    return static_cast<double>(kKernelBatchIters) * 8.0 * lanes * 2.0;
+}
+
+static double RunScalarBatch(double seed)
+{
+    double a0 = seed, a1 = seed + 0.1, a2 = seed + 0.2, a3 = seed + 0.3;
+    double a4 = seed + 0.4, a5 = seed + 0.5, a6 = seed + 0.6, a7 = seed + 0.7;
+    for (std::uint64_t i = 0; i < kKernelBatchIters; ++i) {
+        a0 = a0 * kKernelMul + kKernelAdd;
+        a1 = a1 * kKernelMul + kKernelAdd;
+        a2 = a2 * kKernelMul + kKernelAdd;
+        a3 = a3 * kKernelMul + kKernelAdd;
+        a4 = a4 * kKernelMul + kKernelAdd;
+        a5 = a5 * kKernelMul + kKernelAdd;
+        a6 = a6 * kKernelMul + kKernelAdd;
+        a7 = a7 * kKernelMul + kKernelAdd;
+    }
+    return a0 + a1 + a2 + a3 + a4 + a5 + a6 + a7;
+}
+
+static double RunSSE2Batch(double seed)
+{
+    const __m128d mul = _mm_set1_pd(kKernelMul);
+    const __m128d add = _mm_set1_pd(kKernelAdd);
+    __m128d a[8];
+    for (int k = 0; k < 8; ++k) {
+        a[k] = _mm_set1_pd(seed + 0.1 * k);
+    }
+    for (std::uint64_t i = 0; i < kKernelBatchIters; ++i) {
+        for (int k = 0; k < 8; ++k) {
+            a[k] = _mm_add_pd(_mm_mul_pd(a[k], mul), add);
+        }
+    }
+    __m128d sum = a[0];
+    for (int k = 1; k < 8; ++k) {
+        sum = _mm_add_pd(sum, a[k]);
+    }
+    double out[2];
+    _mm_storeu_pd(out, sum);
+    return out[0] + out[1];
+}
+
+static double RunAVXBatch(double seed)
+{
+    const __m256d mul = _mm256_set1_pd(kKernelMul);
+    const __m256d add = _mm256_set1_pd(kKernelAdd);
+    __m256d a[8];
+    for (int k = 0; k < 8; ++k) {
+        a[k] = _mm256_set1_pd(seed + 0.1 * k);
+    }
+    for (std::uint64_t i = 0; i < kKernelBatchIters; ++i) {
+        for (int k = 0; k < 8; ++k) {
+            a[k] = _mm256_add_pd(_mm256_mul_pd(a[k], mul), add);
+        }
+    }
+    __m256d sum = a[0];
+    for (int k = 1; k < 8; ++k) {
+        sum = _mm256_add_pd(sum, a[k]);
+    }
+    double out[4];
+    _mm256_storeu_pd(out, sum);
+    _mm256_zeroupper();
+    return out[0] + out[1] + out[2] + out[3];
+}
+
+// ---------------------------------------------------------------------------
+// AVX needs both the CPUID bit and OS support for saving YMM state.
+// ---------------------------------------------------------------------------
+static bool IsAVXUsable()
+{
+    int cpuInfo[4] = { 0 };
+    cpuid(cpuInfo, 1);
+    bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+    bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+    if (!avx || !osxsave) {
+        return false;
+    }
+    return (_xgetbv(0) & 0x6) == 0x6;  // XMM and YMM state enabled
+}
+
+struct KernelWorker
+{
+    KernelWidth width;
+    LONGLONG deadline;      // QPC tick at which to stop
+    std::uint64_t batches;
+    double sink;            // keeps the kernel result live
+};
+
+static void KernelThread(KernelWorker* worker)
+{
+    double acc = 1.0;
+    LARGE_INTEGER now;
+    do {
+        switch (worker->width) {
+        case KERNEL_SSE2: acc += RunSSE2Batch(acc); break;
+        case KERNEL_AVX:  acc += RunAVXBatch(acc); break;
+        default:          acc += RunScalarBatch(acc); break;
+        }
+        acc *= 1.0e-3;
+        ++worker->batches;
+        QueryPerformanceCounter(&now);
+    } while (now.QuadPart < worker->deadline);
+    worker->sink = acc;
+}
+
+// ---------------------------------------------------------------------------
+// Run one kernel on `threadCount` threads for ~durationSec and report
+// throughput alongside the energy consumed. Returns GFLOP/J, or a negative
+// value when energy is unavailable.
+// ---------------------------------------------------------------------------
+static double RunKernelWithEnergy(const EnergyMeters& meters, KernelWidth width,
+    unsigned threadCount, double durationSec)
+{
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+
+    std::vector<KernelWorker> workers(threadCount);
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+
+    EnergySample before, after;
+    bool sampled = !meters.channels.empty() && ReadEnergySample(meters, before);
+
+    LARGE_INTEGER startTime, endTime;
+    QueryPerformanceCounter(&startTime);
+    LONGLONG deadline = startTime.QuadPart
+        + static_cast<LONGLONG>(durationSec * static_cast<double>(freq.QuadPart));
+
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers[t].width = width;
+        workers[t].deadline = deadline;
+        workers[t].batches = 0;
+        workers[t].sink = 0.0;
+        threads.emplace_back(KernelThread, &workers[t]);
+    }
+    for (std::thread& th : threads) {
+        th.join();
+    }
+
+    QueryPerformanceCounter(&endTime);
+    sampled = sampled && ReadEnergySample(meters, after);
+
+    double elapsedSec = static_cast<double>(endTime.QuadPart - startTime.QuadPart)
+        / static_cast<double>(freq.QuadPart);
+
+    std::uint64_t totalBatches = 0;
+    for (const KernelWorker& w : workers) {
+        totalBatches += w.batches;
+    }
+    double gflop = static_cast<double>(totalBatches) * KernelBatchFlops(width) / 1.0e9;
+
+    printf("  %-6s x %2u thread(s): %9.2f GFLOP in %.2f s (%.2f GFLOP/s)\n",
+        KernelWidthName(width), threadCount, gflop, elapsedSec, gflop / elapsedSec);
+    return PrintEnergyReport(meters, sampled, before, after, elapsedSec, gflop, "GFLOP");
+}
+
+// ---------------------------------------------------------------------------
+// Compare ISA width and thread count by work per joule.
+// ---------------------------------------------------------------------------
+static void ShowEnergyEfficiency()
+{
+    EnergyMeters meters;
+    OpenEnergyMeters(meters);
+
+    // hardware_concurrency() spans all processor groups, unlike GetSystemInfo()
+    unsigned logicalCount = std::thread::hardware_concurrency();
+    if (logicalCount == 0) {
+        logicalCount = 1;
+    }
+    unsigned physicalCount = static_cast<unsigned>(
+        GetApproxPhysicalCores(static_cast<int>(logicalCount)));
+    if (physicalCount == 0 || physicalCount > logicalCount) {
+        physicalCount = logicalCount;
+    }
+
+    // Thread counts: powers of two below the physical core count, then the
+    // physical core count, then all logical processors.
+    std::vector<unsigned> threadCounts;
+    for (unsigned n = 1; n < physicalCount; n *= 2) {
+        threadCounts.push_back(n);
+    }
+    threadCounts.push_back(physicalCount);
+    if (logicalCount > physicalCount) {
+        threadCounts.push_back(logicalCount);
+    }
+
+    printf("\nEnergy Efficiency (built-in kernels):\n");
+    if (meters.channels.empty()) {
+        printf("  Energy meter: unavailable (%s)\n", meters.unavailableReason.c_str());
+    }
+    else if (HasPackageChannel(meters)) {
+        printf("  Energy meter: %u channel(s), package-wide (includes other processes)\n",
+            static_cast<unsigned>(meters.channels.size()));
+    }
+    else {
+        printf("  Energy meter: %u channel(s), no package domain\n",
+            static_cast<unsigned>(meters.channels.size()));
+    }
+
+    std::vector<KernelWidth> widths;
+    widths.push_back(KERNEL_SCALAR);
+    widths.push_back(KERNEL_SSE2);
+    if (IsAVXUsable()) {
+        widths.push_back(KERNEL_AVX);
+    }
+
+    double bestPerJoule = -1.0;
+    KernelWidth bestWidth = KERNEL_SCALAR;
+    unsigned bestThreads = 0;
+    for (KernelWidth width : widths) {
+        for (unsigned threads : threadCounts) {
+            double perJoule = RunKernelWithEnergy(meters, width, threads, 1.0);
+            if (perJoule > bestPerJoule) {
+                bestPerJoule = perJoule;
+                bestWidth = width;
+                bestThreads = threads;
+            }
+        }
+    }
+
+    if (bestPerJoule > 0.0) {
+        printf("  Best work/joule: %s x %u thread(s), %.3f GFLOP/J\n",
+            KernelWidthName(bestWidth), bestThreads, bestPerJoule);
+    }
+
+    CloseEnergyMeters(meters);
+}
+
+// ---------------------------------------------------------------------------
+// Child-process mode: run a command and report the energy used while it ran.
+// ---------------------------------------------------------------------------
+static const int kChildLaunchFailedExitCode = 127;
+
+// Skip one whitespace-delimited token, treating double quotes as grouping.
+// Only used for argv[0] and "--energy-run", which carry no escapes.
+static const wchar_t* SkipCommandLineToken(const wchar_t* p)
+{
+    while (*p == L' ' || *p == L'\t') {
+        ++p;
+    }
+    bool inQuotes = false;
+    while (*p != L'\0' && (inQuotes || (*p != L' ' && *p != L'\t'))) {
+        if (*p == L'"') {
+            inQuotes = !inQuotes;
+        }
+        ++p;
+    }
+    while (*p == L' ' || *p == L'\t') {
+        ++p;
+    }
+    return p;
+}
+
+// ---------------------------------------------------------------------------
+// The child's command line is the tail of our own Unicode command line after
+// "--energy-run", passed through unchanged so quoting and non-ANSI characters
+// reach the child exactly as the caller wrote them.
+// ---------------------------------------------------------------------------
+static int RunChildWithEnergy()
+{
+    const wchar_t* tail = SkipCommandLineToken(SkipCommandLineToken(GetCommandLineW()));
+    std::wstring cmdLineW(tail);
+    std::string cmdLine = WideToString(cmdLineW.c_str(), cmdLineW.size());
+
+    EnergyMeters meters;
+    OpenEnergyMeters(meters);
+
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+
+    // Pass our standard streams through so redirected output reaches the
+    // same file or pipe as ours.
+    STARTUPINFOW si;
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    si.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+    si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&pi, sizeof(pi));
+
+    EnergySample before, after;
+    bool sampled = !meters.channels.empty() && ReadEnergySample(meters, before);
+
+    LARGE_INTEGER startTime, endTime;
+    QueryPerformanceCounter(&startTime);
+
+    // CreateProcessW may modify the command line buffer in place
+    std::vector<wchar_t> cmdBuf(cmdLineW.begin(), cmdLineW.end());
+    cmdBuf.push_back(L'\0');
+    fflush(stdout);
+    if (!CreateProcessW(nullptr, cmdBuf.data(), nullptr, nullptr, TRUE, 0,
+        nullptr, nullptr, &si, &pi)) {
+        printf("Failed to start \"%s\" (error %lu)\n", cmdLine.c_str(), GetLastError());
+        CloseEnergyMeters(meters);
+        return kChildLaunchFailedExitCode;
+    }
+
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    QueryPerformanceCounter(&endTime);
+    sampled = sampled && ReadEnergySample(meters, after);
+
+    DWORD exitCode = 0;
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+
+    double elapsedSec = static_cast<double>(endTime.QuadPart - startTime.QuadPart)
+        / static_cast<double>(freq.QuadPart);
+
+    printf("\nEnergy for: %s\n", cmdLine.c_str());
+    printf("  Exit code: %lu, elapsed %.3f s\n", exitCode, elapsedSec);
+    PrintEnergyReport(meters, sampled, before, after, elapsedSec, 0.0, nullptr);
+
+    CloseEnergyMeters(meters);
+    return static_cast<int>(exitCode);
+}
+
 // ---------------------------------------------------------------------------
 // main() - Command-line entry point
+//   --energy              also measure work/joule of the built-in kernels
+//   --energy-run CMD ...  run CMD and report the energy it consumed; exits
+//                         with CMD's exit code, or 127 if CMD is missing or
+//                         could not be started
 // ---------------------------------------------------------------------------
-int main()
+int main(int argc, char* argv[])
 {
+    if (argc >= 2 && std::strcmp(argv[1], "--energy-run") == 0) {
+        if (argc < 3) {
+            printf("Usage: %s --energy-run <command> [args...]\n", argv[0]);
+            return kChildLaunchFailedExitCode;
+        }
+        return RunChildWithEnergy();
+    }
+    bool measureEnergy = (argc >= 2 && std::strcmp(argv[1], "--energy") == 0);
+
     printf("===== CPU Information Utility =====\n\n");
 
     // 1. Basic CPU info
@@ -278,6 +952,11 @@ int main()
     double freqMHz = MeasureCPUFrequencyMHz();
     printf("\nApprox. CPU Frequency: %.2f MHz\n", freqMHz);
 
+    // 6. Energy efficiency of the built-in kernels
+    if (measureEnergy) {
+        ShowEnergyEfficiency();
+    }
+
     printf("\n===================================\n");
     return 0;
 }
\ No newline at end of file